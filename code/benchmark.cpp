@@ -0,0 +1,1306 @@
+#include <chrono>
+#include <vector>
+#include <thread>
+#include <fstream>
+#include <cstdio>
+#include <functional>
+#include <mutex>
+#include <atomic>
+#include <numeric>
+#include "util/util.h"
+
+using namespace util;
+
+/// Benchmark suites for every util.h category, run through util::bench::Runner.
+/// Text results go to stderr, so stdout (which the printing suite writes to) can be redirected:
+///     g++ -std=c++20 -O2 -pthread benchmark.cpp -o benchmark
+///     ./benchmark > /dev/null
+/// Options:
+///     --format text|json|csv   report format (default text)
+///     --output <path>          where JSON/CSV go (default stderr)
+///     --filter <text>          only benchmarks whose "suite/name" contains text
+///     --runs <n>               timed runs per benchmark (default 15)
+///     --warmup <n>             warmup runs per benchmark (default 2)
+///     --cpu <n>                pin the benchmarking thread to CPU n
+/// Two JSON or CSV reports from different versions can be diffed line by line.
+
+namespace {
+    /// Distance between two doubles in units in the last place (0 when both are NaN).
+    double ulpDistance(const double a, const double b) {
+        if (a == b || (std::isnan(a) && std::isnan(b))) {
+            return 0;
+        }
+        const auto ordered = [](const double d) {
+            const int64_t bits = std::bit_cast<int64_t>(d);
+            return bits < 0 ? std::numeric_limits<int64_t>::min() - bits : bits;
+        };
+        const uint64_t x = (uint64_t)ordered(a), y = (uint64_t)ordered(b);
+        return double((int64_t)x > (int64_t)y ? x - y : y - x);
+    }
+
+    std::string loremText(const size_t size) {
+        std::string text;
+        text.reserve(size + String::Lorem.size());
+        while (text.size() < size) {
+            text += String::Lorem;
+        }
+        text.resize(size);
+        return text;
+    }
+
+    /// =========================
+    /// PRINTING
+    /// =========================
+
+    void printingSuite(bench::Runner& runner) {
+        runner.suite("printing");
+        if (!runner.enabled({"fprintln (std::cout)", "fprintln (buffered)", "printContainer (std::cout)", "printContainer (buffered)",
+                             "printContainer (ContainerFormat, one write)", "export doubles (std::ostringstream)",
+                             "export doubles (FormatContainer)", "export nested pairs (FormatContainer)", "fprintln x4 threads (std::cout)",
+                             "fprintln x4 threads (async)"})) {
+            return;
+        }
+        constexpr int lines = 100'000;
+
+        const auto printLines = [] {
+            for (int i = 0; i < lines; i++) {
+                fprintln("request ", i, " took ", i * 0.25, " ms");
+            }
+            flush();
+        };
+        SetOutputMode(OutputMode::Stream);
+        runner.run("fprintln (std::cout)", {lines, "lines"}, printLines);
+        SetOutputMode(OutputMode::Buffered);
+        runner.run("fprintln (buffered)", {lines, "lines"}, printLines);
+
+        std::vector<int> values(lines);
+        for (int i = 0; i < lines; i++) {
+            values[i] = i * 7;
+        }
+        SetOutputMode(OutputMode::Stream);
+        runner.run("printContainer (std::cout)", {lines, "elements"}, [&] {
+            printContainer(values);
+            flush();
+        });
+        SetOutputMode(OutputMode::Buffered);
+        runner.run("printContainer (buffered)", {lines, "elements"}, [&] {
+            printContainer(values);
+            flush();
+        });
+        SetOutputMode(OutputMode::Stream);
+        runner.run("printContainer (ContainerFormat, one write)", {lines, "elements"}, [&] {
+            printContainer(values, {.separator = "\n", .open = "", .close = ""});
+            flush();
+        });
+
+        constexpr size_t exported = 200'000;
+        std::vector<double> samples(exported);
+        FillRandFloat(samples, -1e6, 1e6);
+        runner.run("export doubles (std::ostringstream)", {double(exported), "elements"}, [&] {
+            std::ostringstream stream;
+            stream.precision(17);
+            for (const double sample : samples) {
+                stream << sample << ',';
+            }
+            bench::DoNotOptimize(stream.str().size());
+        });
+        runner.run("export doubles (FormatContainer)", {double(exported), "elements"}, [&] {
+            bench::DoNotOptimize(FormatContainer(samples, {.separator = ",", .open = "", .close = ""}).size());
+        });
+        std::vector<std::pair<int, std::vector<int>>> nested(exported / 10, {7, {1, 2, 3, 4, 5, 6, 7, 8}});
+        runner.run("export nested pairs (FormatContainer)", {double(exported), "elements"}, [&] {
+            bench::DoNotOptimize(FormatContainer(nested).size());
+        });
+
+        constexpr int threads = 4;
+        const auto logFromThreads = [] {
+            std::vector<std::thread> workers;
+            for (int t = 0; t < threads; t++) {
+                workers.emplace_back([t] {
+                    for (int i = 0; i < lines / threads; i++) {
+                        fprintln("worker ", t, " processed item ", i);
+                    }
+                });
+            }
+            for (auto& worker : workers) {
+                worker.join();
+            }
+            flush();
+        };
+        SetOutputMode(OutputMode::Stream);
+        runner.run("fprintln x4 threads (std::cout)", {lines, "lines"}, logFromThreads);
+        {
+            FileDescriptorSink out(1);
+            AsyncLogger logger(out);
+            logger.install();
+            runner.run("fprintln x4 threads (async)", {lines, "lines"}, logFromThreads);
+        }
+        SetOutputMode(OutputMode::Stream);
+    }
+
+    /// =========================
+    /// INPUT
+    /// =========================
+
+    void inputSuite(bench::Runner& runner) {
+        runner.suite("input");
+        if (!runner.enabled({"read int+double (std::ifstream)", "read int+double (InputReader)", "read lines (std::getline)",
+                             "read lines (InputReader)", "read CSV columns (std::ifstream)", "read CSV columns (InputReader)",
+                             "read CSV columns (RecordReader)", "read CSV columns (RecordReader, parallel)",
+                             "read CSV rows (RecordReader::readRow)"})) {
+            return;
+        }
+        constexpr int numbers = 1'000'000;
+        const std::string inputPath = "util_benchmark_input.txt";
+        {
+            std::ofstream file(inputPath);
+            for (int i = 0; i < numbers; i++) {
+                file << (i * 2654435761u) % 1000000007 << ' ' << i * 0.001 << '\n';
+            }
+        }
+        std::ifstream sizeProbe(inputPath, std::ios::binary | std::ios::ate);
+        const double fileBytes = double(sizeProbe.tellg());
+
+        long long intSum = 0;
+        double floatSum = 0;
+        runner.run("read int+double (std::ifstream)", {numbers * 2.0, "values", fileBytes}, [&] {
+            std::ifstream file(inputPath);
+            long long a;
+            double b;
+            while (file >> a >> b) {
+                intSum += a;
+                floatSum += b;
+            }
+        });
+        runner.run("read int+double (InputReader)", {numbers * 2.0, "values", fileBytes}, [&] {
+            InputReader reader(inputPath);
+            long long a;
+            double b;
+            while (reader.read(a) && reader.read(b)) {
+                intSum += a;
+                floatSum += b;
+            }
+        });
+        size_t bytes = 0;
+        runner.run("read lines (std::getline)", {numbers, "lines", fileBytes}, [&] {
+            std::ifstream file(inputPath);
+            std::string line;
+            while (std::getline(file, line)) {
+                bytes += line.size();
+            }
+        });
+        runner.run("read lines (InputReader)", {numbers, "lines", fileBytes}, [&] {
+            InputReader reader(inputPath);
+            std::string_view line;
+            while (reader.readLine(line)) {
+                bytes += line.size();
+            }
+        });
+
+        constexpr int records = 1'000'000;
+        const std::string csvPath = "util_benchmark_records.csv";
+        {
+            std::ofstream file(csvPath);
+            file << "id,price,weight,count\n";
+            for (int i = 0; i < records; i++) {
+                file << i << ',' << (i * 2654435761u) % 1000000 * 0.001 << ',' << i % 100000 * 0.01 << ',' << i % 1000 << '\n';
+            }
+        }
+        std::ifstream csvProbe(csvPath, std::ios::binary | std::ios::ate);
+        const double csvBytes = double(csvProbe.tellg());
+        std::vector<long long> ids, counts;
+        std::vector<double> prices, weights;
+        const auto clearColumns = [&] {
+            ids.clear();
+            prices.clear();
+            weights.clear();
+            counts.clear();
+        };
+        runner.run("read CSV columns (std::ifstream)", {records * 4.0, "values", csvBytes}, [&] {
+            clearColumns();
+            std::ifstream file(csvPath);
+            std::string header;
+            std::getline(file, header);
+            long long id, count;
+            double price, weight;
+            char comma;
+            while (file >> id >> comma >> price >> comma >> weight >> comma >> count) {
+                ids.push_back(id);
+                prices.push_back(price);
+                weights.push_back(weight);
+                counts.push_back(count);
+            }
+        });
+        runner.run("read CSV columns (InputReader)", {records * 4.0, "values", csvBytes}, [&] {
+            clearColumns();
+            InputReader reader(csvPath);
+            std::string_view header;
+            reader.readLine(header);
+            long long id, count;
+            double price, weight;
+            char comma;
+            while (reader.read(id) && reader.read(comma) && reader.read(price) && reader.read(comma)
+                   && reader.read(weight) && reader.read(comma) && reader.read(count)) {
+                ids.push_back(id);
+                prices.push_back(price);
+                weights.push_back(weight);
+                counts.push_back(count);
+            }
+        });
+        RecordFormat csv;
+        csv.header = true;
+        runner.run("read CSV columns (RecordReader)", {records * 4.0, "values", csvBytes}, [&] {
+            clearColumns();
+            RecordReader reader(csvPath, csv);
+            reader.readColumns(ids, prices, weights, counts);
+        });
+        csv.parallel = true;
+        runner.run("read CSV columns (RecordReader, parallel)", {records * 4.0, "values", csvBytes}, [&] {
+            clearColumns();
+            RecordReader reader(csvPath, csv);
+            reader.readColumns(ids, prices, weights, counts);
+        });
+        runner.run("read CSV rows (RecordReader::readRow)", {records * 4.0, "values", csvBytes}, [&] {
+            RecordReader reader(csvPath, csv);
+            long long id, count;
+            double price, weight;
+            while (reader.readRow(id, price, weight, count)) {
+                intSum += id + count;
+                floatSum += price + weight;
+            }
+        });
+        bench::DoNotOptimize(intSum);
+        bench::DoNotOptimize(floatSum);
+        bench::DoNotOptimize(bytes);
+        bench::DoNotOptimize(ids.data());
+        std::remove(inputPath.c_str());
+        std::remove(csvPath.c_str());
+    }
+
+    /// =========================
+    /// NUMBERS
+    /// =========================
+
+    void numbersSuite(bench::Runner& runner) {
+        runner.suite("numbers");
+        if (!runner.enabled({"int64 (snprintf)", "int64 (std::to_chars)", "int64 (WriteNumber)", "random double (snprintf %.17g)",
+                             "random double (std::to_chars)", "random double (WriteNumber)", "metric double (snprintf %.17g)",
+                             "metric double (std::to_chars)", "metric double (WriteNumber)", "metric double (std::to_string)",
+                             "metric double (String::ToString)", "parse int64 (strtoll)", "parse int64 (std::from_chars)",
+                             "parse int64 (ParseNumber)", "parse metric double (strtod)", "parse metric double (std::from_chars)",
+                             "parse metric double (ParseNumber)", "IsPalindrome(int)"})) {
+            return;
+        }
+        constexpr size_t count = 1 << 20;
+        std::mt19937_64 numberRng(17);
+        std::vector<int64_t> integers(count);
+        std::vector<double> doubles(count), metrics(count);
+        for (size_t i = 0; i < count; i++) {
+            integers[i] = (int64_t)(numberRng() >> (numberRng() % 64));
+            doubles[i] = std::bit_cast<double>(numberRng() & 0x7FEFFFFFFFFFFFFFull);
+            metrics[i] = double(numberRng() % 10000000) / 1000; // like "1234.567"
+        }
+        char buffer[64];
+        size_t chars = 0;
+        const auto formatAll = [&](auto& values, auto format) {
+            for (const auto value : values) {
+                chars += format(value);
+            }
+        };
+        struct FormatCase {
+            const char* name;
+            std::vector<double>* values;
+        };
+        runner.run("int64 (snprintf)", {double(count), "values"}, [&] {
+            formatAll(integers, [&](int64_t v) { return (size_t)std::snprintf(buffer, sizeof(buffer), "%lld", (long long)v); });
+        });
+        runner.run("int64 (std::to_chars)", {double(count), "values"}, [&] {
+            formatAll(integers, [&](int64_t v) { return (size_t)(std::to_chars(buffer, buffer + sizeof(buffer), v).ptr - buffer); });
+        });
+        runner.run("int64 (WriteNumber)", {double(count), "values"}, [&] {
+            formatAll(integers, [&](int64_t v) { return (size_t)(WriteNumber(buffer, v) - buffer); });
+        });
+        for (const FormatCase& formatCase : {FormatCase{"random double", &doubles}, FormatCase{"metric double", &metrics}}) {
+            const std::string name = formatCase.name;
+            runner.run(name + " (snprintf %.17g)", {double(count), "values"}, [&] {
+                formatAll(*formatCase.values, [&](double v) { return (size_t)std::snprintf(buffer, sizeof(buffer), "%.17g", v); });
+            });
+            runner.run(name + " (std::to_chars)", {double(count), "values"}, [&] {
+                formatAll(*formatCase.values, [&](double v) { return (size_t)(std::to_chars(buffer, buffer + sizeof(buffer), v).ptr - buffer); });
+            });
+            runner.run(name + " (WriteNumber)", {double(count), "values"}, [&] {
+                formatAll(*formatCase.values, [&](double v) { return (size_t)(WriteNumber(buffer, v) - buffer); });
+            });
+        }
+        runner.run("metric double (std::to_string)", {double(count), "values"}, [&] {
+            formatAll(metrics, [&](double v) { return std::to_string(v).size(); });
+        });
+        runner.run("metric double (String::ToString)", {double(count), "values"}, [&] {
+            formatAll(metrics, [&](double v) { return String::ToString(v).size(); });
+        });
+        bench::DoNotOptimize(chars);
+
+        // Parsing back what WriteNumber wrote.
+        std::string integerText, metricText;
+        for (size_t i = 0; i < count; i++) {
+            integerText += NumberText(integers[i]).view();
+            integerText += ' ';
+            metricText += NumberText(metrics[i]).view();
+            metricText += ' ';
+        }
+        const auto tokens = [](const std::string& text, auto parse) {
+            const char* p = text.data();
+            const char* const last = p + text.size();
+            while (p < last) {
+                const char* end = std::find(p, last, ' ');
+                parse(p, end);
+                p = end + 1;
+            }
+        };
+        int64_t integerSum = 0;
+        double doubleSum = 0;
+        runner.run("parse int64 (strtoll)", {double(count), "values", double(integerText.size())}, [&] {
+            tokens(integerText, [&](const char* p, const char*) { integerSum += std::strtoll(p, nullptr, 10); });
+        });
+        runner.run("parse int64 (std::from_chars)", {double(count), "values", double(integerText.size())}, [&] {
+            tokens(integerText, [&](const char* p, const char* end) {
+                int64_t v = 0;
+                std::from_chars(p, end, v);
+                integerSum += v;
+            });
+        });
+        runner.run("parse int64 (ParseNumber)", {double(count), "values", double(integerText.size())}, [&] {
+            tokens(integerText, [&](const char* p, const char* end) {
+                int64_t v = 0;
+                ParseNumber(std::string_view(p, size_t(end - p)), v);
+                integerSum += v;
+            });
+        });
+        runner.run("parse metric double (strtod)", {double(count), "values", double(metricText.size())}, [&] {
+            tokens(metricText, [&](const char* p, const char*) { doubleSum += std::strtod(p, nullptr); });
+        });
+        runner.run("parse metric double (std::from_chars)", {double(count), "values", double(metricText.size())}, [&] {
+            tokens(metricText, [&](const char* p, const char* end) {
+                double v = 0;
+                std::from_chars(p, end, v);
+                doubleSum += v;
+            });
+        });
+        runner.run("parse metric double (ParseNumber)", {double(count), "values", double(metricText.size())}, [&] {
+            tokens(metricText, [&](const char* p, const char* end) {
+                double v = 0;
+                ParseNumber(std::string_view(p, size_t(end - p)), v);
+                doubleSum += v;
+            });
+        });
+        bench::DoNotOptimize(integerSum);
+        bench::DoNotOptimize(doubleSum);
+
+        size_t palindromes = 0;
+        runner.run("IsPalindrome(int)", {double(count), "values"}, [&] {
+            for (size_t i = 0; i < count; i++) {
+                palindromes += IsPalindrome((int)integers[i]);
+            }
+        });
+        bench::DoNotOptimize(palindromes);
+    }
+
+    /// =========================
+    /// STRING SEARCH
+    /// =========================
+
+    void searchSuite(bench::Runner& runner) {
+        runner.suite("search");
+        constexpr size_t haystackSizes[] = {4096, size_t(1) << 20, size_t(64) << 20};
+        constexpr size_t needleSizes[] = {2, 8, 32, 64, 256};
+        const auto label = [](const size_t haystackSize, const size_t needleSize) {
+            return std::to_string(haystackSize >> 10) + " KiB, needle " + std::to_string(needleSize);
+        };
+        std::vector<std::string> names = {"ignore case (ToLower copies)", "ignore case (FindIgnoreCase)", "ignore case (StringSearcher)",
+                                          "300 keywords (SearchFirstSubString loop)", "300 keywords (MultiPatternMatcher)"};
+        for (const size_t haystackSize : haystackSizes) {
+            for (const size_t needleSize : needleSizes) {
+                for (const char* searcher : {"naive ", "String::Find ", "SearchFirstSubString "}) {
+                    names.push_back(searcher + label(haystackSize, needleSize));
+                }
+            }
+        }
+        if (!runner.enabled(std::move(names))) {
+            return;
+        }
+        const auto naiveSearch = [](const std::string& str, const std::string& subString) {
+            const size_t n = str.size(), m = subString.size();
+            for (size_t i = 0; i + m <= n; i++) {
+                size_t j = 0;
+                while (j < m && str[i + j] == subString[j]) {
+                    j++;
+                }
+                if (j == m) {
+                    return (long long)i;
+                }
+            }
+            return -1LL;
+        };
+
+        for (const size_t haystackSize : haystackSizes) {
+            const std::string haystack = loremText(haystackSize);
+            const double size = double(haystackSize);
+            for (const size_t needleSize : needleSizes) {
+                // Not in the text, but made of its letters and ending like it, so filters see candidates.
+                const std::string needle = String::Lorem.substr(0, needleSize - 1) + "#";
+                runner.run("naive " + label(haystackSize, needleSize), {size, "B", size}, [&] {
+                    bench::DoNotOptimize(naiveSearch(haystack, needle));
+                });
+                runner.run("String::Find " + label(haystackSize, needleSize), {size, "B", size}, [&] {
+                    bench::DoNotOptimize(String::Find(haystack, needle));
+                });
+                runner.run("SearchFirstSubString " + label(haystackSize, needleSize), {size, "B", size}, [&] {
+                    bench::DoNotOptimize(String::SearchFirstSubString(haystack, needle));
+                });
+            }
+        }
+
+        {
+            const std::string haystack = loremText(size_t(16) << 20);
+            const double size = double(haystack.size());
+            const std::string needle = "NULLA ET MOLESTIE EROS#";
+            runner.run("ignore case (ToLower copies)", {size, "B", size}, [&] {
+                bench::DoNotOptimize(String::ToLower(haystack).find(String::ToLower(needle)));
+            });
+            runner.run("ignore case (FindIgnoreCase)", {size, "B", size}, [&] {
+                bench::DoNotOptimize(String::FindIgnoreCase(haystack, needle));
+            });
+            const StringSearcher searcher(needle, false);
+            runner.run("ignore case (StringSearcher)", {size, "B", size}, [&] {
+                bench::DoNotOptimize(searcher.find(haystack));
+            });
+        }
+
+        {
+            // 300 keywords, a few of which occur in the text.
+            std::vector<std::string> keywords = { "metus", "feugiat", "volutpat", "aliquet" };
+            std::mt19937 keywordRng(7);
+            while (keywords.size() < 300) {
+                std::string word(5 + keywordRng() % 6, 'a');
+                for (char& c : word) {
+                    c = (char)('a' + keywordRng() % 26);
+                }
+                keywords.push_back(word);
+            }
+            std::vector<std::string> textLines;
+            for (int i = 0; i < 2000; i++) {
+                textLines.push_back(String::Lorem.substr((size_t)i % 150, 100));
+            }
+            const double totalBytes = 100.0 * textLines.size();
+
+            long long hits = 0;
+            runner.run("300 keywords (SearchFirstSubString loop)", {totalBytes, "B", totalBytes}, [&] {
+                hits = 0;
+                for (const std::string& line : textLines) {
+                    for (const std::string& keyword : keywords) {
+                        hits += String::SearchFirstSubString(line, keyword) >= 0;
+                    }
+                }
+            });
+            runner.note("keyword hits", double(hits));
+            const MultiPatternMatcher matcher(keywords);
+            runner.run("300 keywords (MultiPatternMatcher)", {totalBytes, "B", totalBytes}, [&] {
+                hits = 0;
+                for (const std::string& line : textLines) {
+                    hits += (long long)matcher.count(line);
+                }
+            });
+            runner.note("matches", double(hits));
+        }
+    }
+
+    /// =========================
+    /// CASE CONVERSION
+    /// =========================
+
+    void caseSuite(bench::Runner& runner) {
+        runner.suite("case");
+        if (!runner.enabled({"ToUpper (std::transform ::toupper)", "ToUpper (copy)", "ToUpper (caller buffer)",
+                             "ToLowerInPlace (UTF-8 mode)"})) {
+            return;
+        }
+        const std::string text = loremText(size_t(16) << 20);
+        const double size = double(text.size());
+
+        std::string buffer(text.size(), '\0');
+        runner.run("ToUpper (std::transform ::toupper)", {size, "B", size}, [&] {
+            std::transform(text.begin(), text.end(), buffer.begin(), ::toupper);
+            bench::DoNotOptimize(buffer.data());
+        });
+        runner.run("ToUpper (copy)", {size, "B", size}, [&] {
+            bench::DoNotOptimize(String::ToUpper(text).data());
+        });
+        runner.run("ToUpper (caller buffer)", {size, "B", size}, [&] {
+            String::ToUpper(text, buffer.data());
+            bench::DoNotOptimize(buffer.data());
+        });
+        runner.run("ToLowerInPlace (UTF-8 mode)", {size, "B", size}, [&] {
+            String::ToLowerInPlace(buffer, CaseMode::Utf8);
+            bench::DoNotOptimize(buffer.data());
+        });
+    }
+
+    /// =========================
+    /// JOIN / STRING BUILDER
+    /// =========================
+
+    void joinSuite(bench::Runner& runner) {
+        runner.suite("join");
+        if (!runner.enabled({"join 7 pieces (operator+)", "join 7 pieces (String::Join)", "build payload (std::string +=)",
+                             "build payload (StringBuilder)"})) {
+            return;
+        }
+        constexpr int joins = 100'000;
+        const std::string method = "GET", path = "/api/v1/items", version = "HTTP/1.1";
+
+        runner.run("join 7 pieces (operator+)", {joins, "joins"}, [&] {
+            for (int i = 0; i < joins; i++) {
+                bench::DoNotOptimize((method + " " + path + "/" + std::to_string(i) + " " + version).size());
+            }
+        });
+        runner.run("join 7 pieces (String::Join)", {joins, "joins"}, [&] {
+            for (int i = 0; i < joins; i++) {
+                bench::DoNotOptimize(String::Join(method, ' ', path, '/', i, ' ', version).size());
+            }
+        });
+
+        constexpr int pieces = 500'000;
+        runner.run("build payload (std::string +=)", {pieces, "pieces"}, [&] {
+            std::string appended;
+            for (int i = 0; i < pieces; i++) {
+                appended += "item ";
+                appended += std::to_string(i);
+                appended += '\n';
+            }
+            bench::DoNotOptimize(appended.size());
+        });
+        runner.run("build payload (StringBuilder)", {pieces, "pieces"}, [&] {
+            StringBuilder builder;
+            for (int i = 0; i < pieces; i++) {
+                builder.append("item ", i, '\n');
+            }
+            bench::DoNotOptimize(builder.str().size());
+        });
+    }
+
+    /// =========================
+    /// ANAGRAMS
+    /// =========================
+
+    void anagramSuite(bench::Runner& runner) {
+        runner.suite("anagrams");
+        if (!runner.enabled({"IsAnagram pairs (sorted copies)", "IsAnagram pairs (histogram)", "IsAnagram 810 B, ignore case",
+                             "GroupAnagrams 100K words"})) {
+            return;
+        }
+        std::mt19937 wordRng(3);
+        std::vector<std::string> words(100'000);
+        for (std::string& word : words) {
+            word.resize(4 + wordRng() % 8);
+            for (char& c : word) {
+                c = (char)('a' + wordRng() % 8);
+            }
+        }
+        const double pairs = double(words.size() - 1);
+        size_t matches = 0;
+        runner.run("IsAnagram pairs (sorted copies)", {pairs, "pairs"}, [&] {
+            for (size_t i = 1; i < words.size(); i++) {
+                std::string s1 = words[i - 1], s2 = words[i];
+                std::sort(s1.begin(), s1.end());
+                std::sort(s2.begin(), s2.end());
+                matches += s1 == s2;
+            }
+        });
+        runner.run("IsAnagram pairs (histogram)", {pairs, "pairs"}, [&] {
+            for (size_t i = 1; i < words.size(); i++) {
+                matches += String::IsAnagram(words[i - 1], words[i]);
+            }
+        });
+
+        const std::string longText = String::Lorem + String::Lorem + String::Lorem;
+        std::string shuffled = longText;
+        std::shuffle(shuffled.begin(), shuffled.end(), wordRng);
+        const double size = double(longText.size());
+        runner.run("IsAnagram 810 B, ignore case", {size, "B", size}, [&] {
+            matches += String::IsAnagram(longText, shuffled, false);
+        });
+        size_t classes = 0;
+        runner.run("GroupAnagrams 100K words", {double(words.size()), "words"}, [&] {
+            classes = String::GroupAnagrams(words).size();
+        });
+        runner.note("classes", double(classes));
+        bench::DoNotOptimize(matches);
+    }
+
+    /// =========================
+    /// INTERNING
+    /// =========================
+
+    void internSuite(bench::Runner& runner) {
+        runner.suite("interning");
+        if (!runner.enabled({"hash identifiers (std::hash)", "hash identifiers (String::Hash)", "hash 1 MB (std::hash)",
+                             "hash 1 MB (String::Hash)", "intern (std::unordered_map<std::string, id>)",
+                             "intern (std::unordered_map, String::Hasher lookup)", "intern (StringPool)",
+                             "intern (ConcurrentStringPool, 1 thread)", "intern (ConcurrentStringPool, ParallelFor)",
+                             "compare neighbours (strings)", "compare neighbours (interned ids)"})) {
+            return;
+        }
+        std::mt19937 nameRng(11);
+        // 1M identifiers drawn from 100K distinct ones, like the keys of a log or event stream.
+        std::vector<std::string> distinct(100'000);
+        for (std::string& name : distinct) {
+            name = "service." + std::to_string(nameRng() % 1000) + ".metric_" + std::to_string(nameRng());
+        }
+        std::vector<std::string_view> stream(1'000'000);
+        double streamBytes = 0;
+        for (std::string_view& name : stream) {
+            name = distinct[nameRng() % distinct.size()];
+            streamBytes += double(name.size());
+        }
+        const double count = double(stream.size());
+
+        uint64_t hashes = 0;
+        runner.run("hash identifiers (std::hash)", {count, "strings", streamBytes}, [&] {
+            for (const std::string_view name : stream) {
+                hashes += std::hash<std::string_view>{}(name);
+            }
+        });
+        runner.run("hash identifiers (String::Hash)", {count, "strings", streamBytes}, [&] {
+            for (const std::string_view name : stream) {
+                hashes += String::Hash(name);
+            }
+        });
+        const std::string longText = loremText(1 << 20);
+        const double longBytes = double(longText.size());
+        runner.run("hash 1 MB (std::hash)", {longBytes, "B", longBytes}, [&] {
+            hashes += std::hash<std::string_view>{}(longText);
+        });
+        runner.run("hash 1 MB (String::Hash)", {longBytes, "B", longBytes}, [&] {
+            hashes += String::Hash(longText);
+        });
+
+        size_t ids = 0;
+        runner.run("intern (std::unordered_map<std::string, id>)", {count, "strings", streamBytes}, [&] {
+            std::unordered_map<std::string, uint32_t> table;
+            for (const std::string_view name : stream) {
+                ids += table.try_emplace(std::string(name), (uint32_t)table.size()).first->second;
+            }
+        });
+        runner.run("intern (std::unordered_map, String::Hasher lookup)", {count, "strings", streamBytes}, [&] {
+            std::unordered_map<std::string, uint32_t, String::Hasher, std::equal_to<>> table;
+            for (const std::string_view name : stream) {
+                auto found = table.find(name);
+                if (found == table.end()) {
+                    found = table.emplace(std::string(name), (uint32_t)table.size()).first;
+                }
+                ids += found->second;
+            }
+        });
+        runner.run("intern (StringPool)", {count, "strings", streamBytes}, [&] {
+            StringPool pool;
+            for (const std::string_view name : stream) {
+                ids += pool.intern(name);
+            }
+        });
+        runner.run("intern (ConcurrentStringPool, 1 thread)", {count, "strings", streamBytes}, [&] {
+            ConcurrentStringPool pool;
+            for (const std::string_view name : stream) {
+                ids += pool.intern(name);
+            }
+        });
+        runner.run("intern (ConcurrentStringPool, ParallelFor)", {count, "strings", streamBytes}, [&] {
+            ConcurrentStringPool pool;
+            std::atomic<size_t> sum{ 0 };
+            ParallelFor(0, stream.size(), [&](const size_t first, const size_t last) {
+                size_t local = 0;
+                for (size_t i = first; i < last; i++) {
+                    local += pool.intern(stream[i]);
+                }
+                sum += local;
+            });
+            ids += sum;
+        });
+
+        StringPool pool;
+        std::vector<StringPool::Id> interned(stream.size());
+        for (size_t i = 0; i < stream.size(); i++) {
+            interned[i] = pool.intern(stream[i]);
+        }
+        size_t equal = 0;
+        runner.run("compare neighbours (strings)", {count - 1, "pairs"}, [&] {
+            for (size_t i = 1; i < stream.size(); i++) {
+                equal += stream[i - 1] == stream[i];
+            }
+        });
+        runner.run("compare neighbours (interned ids)", {count - 1, "pairs"}, [&] {
+            for (size_t i = 1; i < interned.size(); i++) {
+                equal += interned[i - 1] == interned[i];
+            }
+        });
+        runner.note("distinct", double(pool.size()));
+        bench::DoNotOptimize(hashes);
+        bench::DoNotOptimize(ids);
+        bench::DoNotOptimize(equal);
+    }
+
+    /// =========================
+    /// BATCH MATH
+    /// =========================
+
+    void mathSuite(bench::Runner& runner) {
+        runner.suite("math");
+        const char* levelNames[] = {"scalar", "AVX2", "AVX-512"};
+        std::vector<std::string> names = {"batch::sine (float)", "F -> C -> K, chained scalar calls"};
+        for (const char* kernel : {"sine", "cosine", "tangent", "Logarithm(10)", "power", "squareRoot", "n_Root(5)"}) {
+            names.push_back(std::string(kernel) + " (one at a time)");
+            for (const char* level : levelNames) {
+                names.push_back(std::string("batch::") + kernel + " (" + level + ")");
+            }
+        }
+        for (const char* level : levelNames) {
+            names.push_back(std::string("units::convert F -> K, fused (") + level + ")");
+        }
+        if (!runner.enabled(std::move(names))) {
+            return;
+        }
+        constexpr size_t count = 1 << 20;
+        const double bytes = double(count) * sizeof(double);
+        std::mt19937_64 mathRng(11);
+        std::uniform_real_distribution<double> angle(-100.0, 100.0), positive(1e-3, 1e3), exponent(-8.0, 8.0);
+        std::vector<double> angles(count), positives(count), exponents(count), out(count), expected(count);
+        for (size_t i = 0; i < count; i++) {
+            angles[i] = angle(mathRng);
+            positives[i] = positive(mathRng);
+            exponents[i] = exponent(mathRng);
+        }
+
+        struct MathCase {
+            const char* name;
+            std::function<double(size_t)> scalar;
+            std::function<void()> batched;
+        };
+        const MathCase cases[] = {
+            {"sine", [&](size_t i) { return sine(angles[i]); }, [&] { batch::sine(angles, out); }},
+            {"cosine", [&](size_t i) { return cosine(angles[i]); }, [&] { batch::cosine(angles, out); }},
+            {"tangent", [&](size_t i) { return tangent(angles[i]); }, [&] { batch::tangent(angles, out); }},
+            {"Logarithm(10)", [&](size_t i) { return Logarithm(10, positives[i]); }, [&] { batch::Logarithm(10, positives, out); }},
+            {"power", [&](size_t i) { return power(positives[i], exponents[i]); }, [&] { batch::power(positives, exponents, out); }},
+            {"squareRoot", [&](size_t i) { return squareRoot(positives[i]); }, [&] { batch::squareRoot(positives, out); }},
+            {"n_Root(5)", [&](size_t i) { return n_Root(5, positives[i]); }, [&] { batch::n_Root(5, positives, out); }},
+        };
+        const SimdLevel best = batch::GetSimdLevel();
+        for (const MathCase& mathCase : cases) {
+            // std::function keeps the scalar loop from being vectorized.
+            runner.run(std::string(mathCase.name) + " (one at a time)", {double(count), "values", bytes}, [&] {
+                for (size_t i = 0; i < count; i++) {
+                    expected[i] = mathCase.scalar(i);
+                }
+            });
+            for (int level = 0; level <= (int)best; level++) {
+                batch::SetSimdLevel(SimdLevel(level));
+                const std::string name = std::string("batch::") + mathCase.name + " (" + levelNames[level] + ")";
+                if (runner.run(name, {double(count), "values", bytes}, mathCase.batched)) {
+                    double maxUlp = 0;
+                    for (size_t i = 0; i < count; i++) {
+                        maxUlp = std::max(maxUlp, ulpDistance(out[i], mathCase.scalar(i)));
+                    }
+                    runner.note("max error ULP", maxUlp);
+                }
+            }
+            batch::SetSimdLevel(best);
+        }
+
+        std::vector<float> floats(count), floatOut(count);
+        for (size_t i = 0; i < count; i++) {
+            floats[i] = (float)angles[i];
+        }
+        if (runner.run("batch::sine (float)", {double(count), "values", double(count) * sizeof(float)}, [&] {
+                batch::sine(std::span<const float>(floats), std::span<float>(floatOut));
+            })) {
+            int maxFloatUlp = 0;
+            for (size_t i = 0; i < count; i++) {
+                const float reference = (float)std::sin((double)floats[i]);
+                maxFloatUlp = std::max(maxFloatUlp, std::abs(std::bit_cast<int32_t>(floatOut[i]) - std::bit_cast<int32_t>(reference)));
+            }
+            runner.note("max error float ULP", maxFloatUlp);
+        }
+
+        /// Unit conversions.
+        constexpr size_t readingsCount = 1'000'000;
+        std::uniform_real_distribution<double> fahrenheit(-40.0, 120.0);
+        std::vector<double> readings(readingsCount), chained(readingsCount), fused(readingsCount);
+        for (double& reading : readings) {
+            reading = fahrenheit(mathRng);
+        }
+        const double readingBytes = double(readingsCount) * sizeof(double);
+        runner.run("F -> C -> K, chained scalar calls", {double(readingsCount), "values", readingBytes}, [&] {
+            for (size_t i = 0; i < readingsCount; i++) {
+                chained[i] = FromCelsiusToK(FromFahrenheitToC(readings[i]));
+            }
+        });
+        for (int level = 0; level <= (int)best; level++) {
+            batch::SetSimdLevel(SimdLevel(level));
+            const std::string name = std::string("units::convert F -> K, fused (") + levelNames[level] + ")";
+            if (runner.run(name, {double(readingsCount), "values", readingBytes}, [&] {
+                    units::convert<units::Fahrenheit, units::Kelvin>(readings, fused);
+                })) {
+                double maxDifference = 0;
+                for (size_t i = 0; i < readingsCount; i++) {
+                    maxDifference = std::max(maxDifference, std::fabs(fused[i] - FromCelsiusToK(FromFahrenheitToC(readings[i]))));
+                }
+                runner.note("max difference K", maxDifference);
+            }
+        }
+        batch::SetSimdLevel(best);
+    }
+
+    /// =========================
+    /// STATISTICS
+    /// =========================
+
+    void statsSuite(bench::Runner& runner) {
+        runner.suite("stats");
+        const char* levelNames[] = {"scalar", "AVX2", "AVX-512"};
+        std::vector<std::string> names = {"sum (plain loop)", "dot (std::inner_product)", "min/max (std::minmax_element)",
+                                          "Accumulator::add, one value at a time", "p50/p99/p999 (copy + sort)",
+                                          "QuantileSketch::add + p50/p99/p999"};
+        for (const char* level : levelNames) {
+            for (const char* kernel : {"stats::Sum", "stats::Dot", "stats::MinMax", "Accumulator::add(span)"}) {
+                names.push_back(std::string(kernel) + " (" + level + ")");
+            }
+        }
+        if (!runner.enabled(std::move(names))) {
+            return;
+        }
+        constexpr size_t count = 1 << 22;
+        const double bytes = double(count) * sizeof(double);
+        std::mt19937_64 statsRng(23);
+        std::lognormal_distribution<double> latency(0.0, 1.5);
+        std::vector<double> values(count), weights(count);
+        for (size_t i = 0; i < count; i++) {
+            values[i] = latency(statsRng);
+            weights[i] = latency(statsRng);
+        }
+
+        double result = 0;
+        runner.run("sum (plain loop)", {double(count), "values", bytes}, [&] {
+            double sum = 0;
+            for (const double value : values) {
+                sum += value;
+            }
+            result = sum;
+        });
+        runner.run("dot (std::inner_product)", {double(count), "values", 2 * bytes}, [&] {
+            result = std::inner_product(values.begin(), values.end(), weights.begin(), 0.0);
+        });
+        runner.run("min/max (std::minmax_element)", {double(count), "values", bytes}, [&] {
+            const auto [lo, hi] = std::minmax_element(values.begin(), values.end());
+            result = *hi - *lo;
+        });
+        const SimdLevel best = batch::GetSimdLevel();
+        for (int level = 0; level <= (int)best; level++) {
+            batch::SetSimdLevel(SimdLevel(level));
+            const std::string suffix = std::string(" (") + levelNames[level] + ")";
+            runner.run("stats::Sum" + suffix, {double(count), "values", bytes}, [&] { result = stats::Sum(values); });
+            runner.run("stats::Dot" + suffix, {double(count), "values", 2 * bytes}, [&] { result = stats::Dot(values, weights); });
+            runner.run("stats::MinMax" + suffix, {double(count), "values", bytes}, [&] {
+                const stats::Range range = stats::MinMax(values);
+                result = range.max - range.min;
+            });
+            runner.run("Accumulator::add(span)" + suffix, {double(count), "values", bytes}, [&] {
+                stats::Accumulator accumulator;
+                accumulator.add(values);
+                result = accumulator.variance();
+            });
+        }
+        batch::SetSimdLevel(best);
+        runner.run("Accumulator::add, one value at a time", {double(count), "values", bytes}, [&] {
+            stats::Accumulator accumulator;
+            for (const double value : values) {
+                accumulator.add(value);
+            }
+            result = accumulator.variance();
+        });
+
+        std::vector<double> sorted;
+        runner.run("p50/p99/p999 (copy + sort)", {double(count), "values", bytes}, [&] {
+            sorted = values;
+            std::sort(sorted.begin(), sorted.end());
+            result = sorted[count / 2] + sorted[count / 100 * 99] + sorted[count / 1000 * 999];
+        });
+        stats::QuantileSketch sketch;
+        if (runner.run("QuantileSketch::add + p50/p99/p999", {double(count), "values", bytes}, [&] {
+                sketch.reset();
+                sketch.add(values);
+                result = sketch.quantile(0.5) + sketch.quantile(0.99) + sketch.quantile(0.999);
+            })) {
+            if (sorted.empty()) {
+                sorted = values;
+                std::sort(sorted.begin(), sorted.end());
+            }
+            double maxRankError = 0;
+            for (const double q : {0.5, 0.9, 0.99, 0.999}) {
+                const double estimate = sketch.quantile(q);
+                const double rank = double(std::lower_bound(sorted.begin(), sorted.end(), estimate) - sorted.begin()) / double(count);
+                maxRankError = std::max(maxRankError, std::fabs(rank - q));
+            }
+            runner.note("max rank error", maxRankError);
+            runner.note("centroids", double(sketch.size()));
+        }
+        bench::DoNotOptimize(result);
+    }
+
+    /// =========================
+    /// RANDOM
+    /// =========================
+
+    void randomSuite(bench::Runner& runner) {
+        runner.suite("random");
+        if (!runner.enabled({"std::mt19937 (32-bit)", "std::mt19937_64", "SplitMix64", "Xoshiro256pp", "Pcg64", "Philox4x32",
+                             "pi, shared std::mt19937 + mutex", "pi, thread-local RandFloat", "ints, mt19937 + distribution per call",
+                             "ints, RandInt", "ints, FillRandInt", "doubles, RandFloat", "doubles, FillRandFloat", "bools, RandomBool",
+                             "bools, FillRandomBool", "Philox4x32::fill", "Philox4x32 stream, 1 thread", "Philox4x32 stream, all threads",
+                             "weighted, std::discrete_distribution", "weighted, AliasTable", "ReservoirSample, k = 1000",
+                             "std::shuffle + mt19937_64", "Shuffle", "ParallelShuffle, 1 thread", "ParallelShuffle, all threads"})) {
+            return;
+        }
+        constexpr size_t draws = 1'000'000;
+        const double drawBytes = double(draws) * sizeof(uint64_t);
+        const auto timeEngine = [&](const char* name, auto& engine) {
+            runner.run(name, {double(draws), "values", drawBytes}, [&] {
+                uint64_t sum = 0;
+                for (size_t i = 0; i < draws; i++) {
+                    sum += engine();
+                }
+                bench::DoNotOptimize(sum);
+            });
+        };
+        std::mt19937 mersenne(1);
+        std::mt19937_64 mersenne64(1);
+        SplitMix64 splitMix(1);
+        Xoshiro256pp xoshiro(1);
+        Pcg64 pcg(1);
+        Philox4x32 philox(1);
+        timeEngine("std::mt19937 (32-bit)", mersenne);
+        timeEngine("std::mt19937_64", mersenne64);
+        timeEngine("SplitMix64", splitMix);
+        timeEngine("Xoshiro256pp", xoshiro);
+        timeEngine("Pcg64", pcg);
+        timeEngine("Philox4x32", philox);
+
+        // Monte Carlo pi: the old shared engine behind a mutex against the thread-local engines.
+        const unsigned threads = std::max(2u, std::thread::hardware_concurrency());
+        constexpr size_t samplesPerThread = 250'000;
+        const double samples = double(samplesPerThread) * threads;
+        const auto estimatePi = [&](const std::string& name, auto sample) {
+            std::atomic<uint64_t> inside{0};
+            runner.run(name, {samples, "samples"}, [&] {
+                std::vector<std::thread> workers;
+                for (unsigned t = 0; t < threads; t++) {
+                    workers.emplace_back([&, t] {
+                        uint64_t hits = 0;
+                        for (size_t i = 0; i < samplesPerThread; i++) {
+                            hits += sample(t);
+                        }
+                        inside += hits;
+                    });
+                }
+                for (std::thread& worker : workers) {
+                    worker.join();
+                }
+            });
+            bench::DoNotOptimize(inside.load());
+        };
+        std::mt19937 shared(1);
+        std::mutex sharedMutex;
+        estimatePi("pi, shared std::mt19937 + mutex", [&](unsigned) {
+            std::uniform_real_distribution<double> unit(0.0, 1.0);
+            std::lock_guard<std::mutex> lock(sharedMutex);
+            const double x = unit(shared), y = unit(shared);
+            return x * x + y * y <= 1.0;
+        });
+        SeedRandom(1);
+        estimatePi("pi, thread-local RandFloat", [&](unsigned t) {
+            thread_local bool seeded = false;
+            if (!seeded) {
+                SeedThreadRandom(t);
+                seeded = true;
+            }
+            const double x = RandFloat(), y = RandFloat();
+            return x * x + y * y <= 1.0;
+        });
+
+        /// Bulk fills.
+        constexpr size_t count = 1'000'000;
+        std::vector<int> ints(count);
+        std::vector<double> doubles(count);
+        std::unique_ptr<bool[]> bools(new bool[count]);
+        runner.run("ints, mt19937 + distribution per call", {double(count), "values"}, [&] {
+            for (size_t i = 0; i < count; i++) {
+                ints[i] = std::uniform_int_distribution<int>(0, 999)(mersenne);
+            }
+        });
+        runner.run("ints, RandInt", {double(count), "values"}, [&] {
+            for (size_t i = 0; i < count; i++) {
+                ints[i] = RandInt(0, 999);
+            }
+        });
+        runner.run("ints, FillRandInt", {double(count), "values"}, [&] { FillRandInt(ints, 0, 999); });
+        runner.run("doubles, RandFloat", {double(count), "values"}, [&] {
+            for (size_t i = 0; i < count; i++) {
+                doubles[i] = RandFloat(-1.0, 1.0);
+            }
+        });
+        runner.run("doubles, FillRandFloat", {double(count), "values"}, [&] { FillRandFloat(doubles, -1.0, 1.0); });
+        runner.run("bools, RandomBool", {double(count), "values"}, [&] {
+            for (size_t i = 0; i < count; i++) {
+                bools[i] = RandomBool();
+            }
+        });
+        runner.run("bools, FillRandomBool", {double(count), "values"}, [&] {
+            FillRandomBool(std::span<bool>(bools.get(), count));
+        });
+        bench::DoNotOptimize(ints.data());
+        bench::DoNotOptimize(doubles.data());
+        bench::DoNotOptimize(bools.get());
+
+        /// Counter-based streams: the same stream split between 1 and all threads must give the same values.
+        std::vector<uint64_t> values(count);
+        runner.run("Philox4x32::fill", {double(count), "values", drawBytes}, [&] { philox.fill(values.data(), count); });
+        const auto generate = [&](const unsigned workers, std::vector<uint64_t>& out) {
+            std::vector<std::thread> pool;
+            for (unsigned t = 0; t < workers; t++) {
+                pool.emplace_back([&, t] {
+                    const size_t first = count * t / workers, last = count * (t + 1) / workers;
+                    Philox4x32 engine = Philox4x32::stream(1, 0);
+                    engine.discard(first);
+                    engine.fill(out.data() + first, last - first);
+                });
+            }
+            for (std::thread& worker : pool) {
+                worker.join();
+            }
+        };
+        std::vector<uint64_t> single(count), split(count);
+        runner.run("Philox4x32 stream, 1 thread", {double(count), "values", drawBytes}, [&] { generate(1, single); });
+        if (runner.run("Philox4x32 stream, all threads", {double(count), "values", drawBytes}, [&] { generate(threads, split); })) {
+            generate(1, single);
+            runner.note("identical on 1 and all threads", single == split);
+        }
+
+        /// Sampling and shuffling.
+        std::vector<double> weights(1000);
+        FillRandFloat(weights, 0.0, 1.0);
+        std::discrete_distribution<size_t> discrete(weights.begin(), weights.end());
+        runner.run("weighted, std::discrete_distribution", {double(draws), "draws"}, [&] {
+            size_t sum = 0;
+            for (size_t i = 0; i < draws; i++) {
+                sum += discrete(mersenne64);
+            }
+            bench::DoNotOptimize(sum);
+        });
+        const AliasTable table(weights);
+        runner.run("weighted, AliasTable", {double(draws), "draws"}, [&] {
+            size_t sum = 0;
+            for (size_t i = 0; i < draws; i++) {
+                sum += table();
+            }
+            bench::DoNotOptimize(sum);
+        });
+
+        std::vector<uint32_t> data(8'000'000);
+        for (size_t i = 0; i < data.size(); i++) {
+            data[i] = (uint32_t)i;
+        }
+        const double items = double(data.size());
+        const double dataBytes = items * sizeof(uint32_t);
+        runner.run("ReservoirSample, k = 1000", {items, "items", dataBytes}, [&] {
+            bench::DoNotOptimize(ReservoirSample(data.begin(), data.end(), 1000)[0]);
+        });
+        runner.run("std::shuffle + mt19937_64", {items, "items", dataBytes}, [&] { std::shuffle(data.begin(), data.end(), mersenne64); });
+        runner.run("Shuffle", {items, "items", dataBytes}, [&] { Shuffle(std::span<uint32_t>(data)); });
+        ThreadPool callerOnly(0);
+        runner.run("ParallelShuffle, 1 thread", {items, "items", dataBytes}, [&] { ParallelShuffle(std::span<uint32_t>(data), 1, callerOnly); });
+        runner.run("ParallelShuffle, all threads", {items, "items", dataBytes}, [&] { ParallelShuffle(std::span<uint32_t>(data), 1); });
+    }
+    /// =========================
+    /// PROFILING
+    /// =========================
+
+    void profilingSuite(bench::Runner& runner) {
+        runner.suite("profiling");
+        if (!runner.enabled({"one shared atomic, all threads", "Counter::add, all threads", "Histogram::record",
+                             "Histogram::record, all threads", "ScopedTimer", "std::chrono::steady_clock::now pair"})) {
+            return;
+        }
+        constexpr size_t events = 1'000'000;
+        const unsigned threads = std::max(2u, std::thread::hardware_concurrency());
+        const auto fromThreads = [&](auto event) {
+            std::vector<std::thread> workers;
+            for (unsigned t = 0; t < threads; t++) {
+                workers.emplace_back([&] {
+                    for (size_t i = 0; i < events / threads; i++) {
+                        event(i);
+                    }
+                });
+            }
+            for (std::thread& worker : workers) {
+                worker.join();
+            }
+        };
+
+        std::atomic<uint64_t> shared{0};
+        Counter& counter = GetCounter("benchmark.events");
+        Histogram& histogram = GetHistogram("benchmark.latency");
+        runner.run("one shared atomic, all threads", {double(events), "events"}, [&] {
+            fromThreads([&](size_t) { shared.fetch_add(1, std::memory_order_relaxed); });
+        });
+        runner.run("Counter::add, all threads", {double(events), "events"}, [&] {
+            fromThreads([&](size_t) { counter.add(); });
+        });
+        runner.run("Histogram::record", {double(events), "events"}, [&] {
+            for (size_t i = 0; i < events; i++) {
+                histogram.record(i & 0xFFFF);
+            }
+        });
+        runner.run("Histogram::record, all threads", {double(events), "events"}, [&] {
+            fromThreads([&](size_t i) { histogram.record(i & 0xFFFF); });
+        });
+        runner.run("ScopedTimer", {double(events), "scopes"}, [&] {
+            for (size_t i = 0; i < events; i++) {
+                ScopedTimer timer(histogram);
+            }
+        });
+        runner.run("std::chrono::steady_clock::now pair", {double(events), "scopes"}, [&] {
+            for (size_t i = 0; i < events; i++) {
+                const auto start = std::chrono::steady_clock::now();
+                histogram.record((uint64_t)(std::chrono::steady_clock::now() - start).count());
+            }
+        });
+        bench::DoNotOptimize(shared.load());
+    }
+    /// =========================
+    /// CONCURRENCY
+    /// =========================
+
+    void concurrencySuite(bench::Runner& runner) {
+        runner.suite("concurrency");
+        if (!runner.enabled({"Find, 256 MB", "ParallelFind, 256 MB", "ParallelFind ignore case, 256 MB", "batch::sine",
+                             "batch::parallel::sine, 1 thread", "batch::parallel::sine, all threads", "serial sum loop",
+                             "ParallelReduce sum, 1 thread", "ParallelReduce sum, all threads", "ParallelFor, tiny tasks"})) {
+            return;
+        }
+        const unsigned threads = ThreadPool::global().concurrency();
+        ThreadPool single(0);
+
+        const std::string text = loremText(size_t{256} << 20) + "needle";
+        const double textBytes = double(text.size());
+        size_t found = 0;
+        runner.run("Find, 256 MB", {textBytes, "bytes", textBytes}, [&] { found = String::Find(text, "needle"); });
+        runner.run("ParallelFind, 256 MB", {textBytes, "bytes", textBytes}, [&] {
+            found = String::ParallelFind(text, "needle");
+        });
+        runner.note("threads", threads);
+        runner.run("ParallelFind ignore case, 256 MB", {textBytes, "bytes", textBytes}, [&] {
+            found = String::ParallelFind(text, "NEEDLE", false);
+        });
+        bench::DoNotOptimize(found);
+
+        constexpr size_t count = size_t{1} << 24;
+        const double bytes = double(count) * sizeof(double);
+        std::vector<double> values(count), out(count);
+        std::mt19937_64 valueRng(5);
+        std::uniform_real_distribution<double> angle(-100.0, 100.0);
+        for (double& value : values) {
+            value = angle(valueRng);
+        }
+        runner.run("batch::sine", {double(count), "values", bytes}, [&] { batch::sine(values, out); });
+        runner.run("batch::parallel::sine, 1 thread", {double(count), "values", bytes}, [&] { batch::parallel::sine(values, out, single); });
+        runner.run("batch::parallel::sine, all threads", {double(count), "values", bytes}, [&] { batch::parallel::sine(values, out); });
+
+        double total = 0;
+        runner.run("serial sum loop", {double(count), "values", bytes}, [&] {
+            total = 0;
+            for (const double value : values) {
+                total += value;
+            }
+        });
+        const auto reduce = [&](ThreadPool& pool) {
+            total = ParallelReduce(0, count, 0.0, [&](size_t first, size_t last) {
+                double partial = 0;
+                for (size_t i = first; i < last; i++) {
+                    partial += values[i];
+                }
+                return partial;
+            }, std::plus<>{}, 0, pool);
+        };
+        runner.run("ParallelReduce sum, 1 thread", {double(count), "values", bytes}, [&] { reduce(single); });
+        runner.run("ParallelReduce sum, all threads", {double(count), "values", bytes}, [&] { reduce(ThreadPool::global()); });
+        bench::DoNotOptimize(total);
+
+        constexpr size_t tasks = 100'000;
+        std::atomic<size_t> done{0};
+        runner.run("ParallelFor, tiny tasks", {double(tasks), "tasks"}, [&] {
+            ParallelFor(0, tasks, [&](size_t) { done.fetch_add(1, std::memory_order_relaxed); }, 1);
+        });
+        bench::DoNotOptimize(done.load());
+    }
+}
+
+
+int main(int argc, char** argv) {
+    bench::Options options;
+    bench::Format format = bench::Format::Text;
+    std::string outputPath;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const std::string_view flag = argv[i];
+        const char* value = argv[i + 1];
+        if (flag == "--format") {
+            const std::string_view name = value;
+            format = name == "json" ? bench::Format::Json : name == "csv" ? bench::Format::Csv : bench::Format::Text;
+        } else if (flag == "--output") {
+            outputPath = value;
+        } else if (flag == "--filter") {
+            options.filter = value;
+        } else if (flag == "--runs") {
+            options.runs = std::atoi(value);
+        } else if (flag == "--warmup") {
+            options.warmupRuns = std::atoi(value);
+        } else if (flag == "--cpu") {
+            options.cpu = std::atoi(value);
+        } else {
+            std::cerr << "unknown option " << flag << '\n';
+            return 1;
+        }
+    }
+
+    bench::Runner runner(options, format);
+    printingSuite(runner);
+    inputSuite(runner);
+    numbersSuite(runner);
+    searchSuite(runner);
+    caseSuite(runner);
+    joinSuite(runner);
+    anagramSuite(runner);
+    internSuite(runner);
+    mathSuite(runner);
+    statsSuite(runner);
+    randomSuite(runner);
+    profilingSuite(runner);
+    concurrencySuite(runner);
+
+    if (format != bench::Format::Text) {
+        if (outputPath.empty()) {
+            runner.write(std::cerr);
+        } else {
+            std::ofstream out(outputPath);
+            runner.write(out);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,306 @@
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "util/util.h"
+
+using namespace util;
+
+/// Regression tests for util.h. Prints every failed check to stderr and exits with status 1 if there was one:
+///     g++ -std=c++20 -O2 -pthread tests.cpp -o tests
+///     ./tests
+
+namespace {
+    int failures = 0;
+
+    void check(const bool ok, const char* expression, const int line) {
+        if (!ok) {
+            std::fprintf(stderr, "tests.cpp:%d: check failed: %s\n", line, expression);
+            failures++;
+        }
+    }
+    #define CHECK(expression) check((expression), #expression, __LINE__)
+
+    /// =========================
+    /// NUMBERS
+    /// =========================
+
+    template<typename T>
+    void signTests() {
+        for (const char* text : { "+-5", "-+5", "++5", "--5", "+-inf", "+-nan", "+-0.5e3", "+", "-", "+-" }) {
+            T value = T(7);
+            CHECK(!ParseNumber(text, value));
+            CHECK(value == T(7));
+        }
+        T value{};
+        CHECK(ParseNumber("+5", value) && value == T(5));
+        CHECK(ParseNumber("-5", value) && value == T(-5));
+        CHECK(ParseNumber("+2.5e1", value) && value == T(25));
+        CHECK(ParseNumber("+inf", value) && std::isinf(value) && value > 0);
+    }
+
+    void parseNumberTests() {
+        signTests<double>();
+        signTests<float>();
+        signTests<long double>();
+        for (const char* text : { "+-5", "-+5", "++5" }) {
+            int value = 7;
+            CHECK(!ParseNumber(text, value));
+            CHECK(value == 7);
+        }
+        int value = 0;
+        CHECK(ParseNumber("+5", value) && value == 5);
+    }
+
+    /// =========================
+    /// INPUT
+    /// =========================
+
+    void inputReaderTests() {
+        InputReader reader("/nonexistent/util-tests-input");
+        CHECK(!reader.good());
+        CHECK(reader.eof());
+        std::string_view line = "unchanged";
+        CHECK(!reader.readLine(line));
+        CHECK(line.empty());
+        int value = 7;
+        CHECK(!reader.read(value));
+        CHECK(value == 0);
+    }
+
+    /// =========================
+    /// STRINGS
+    /// =========================
+
+    void stringBuilderTests() {
+        {
+            StringBuilder builder;
+            builder.reserve(1000);
+            builder.reserve(5000);
+            builder.append("x");
+            CHECK(builder.size() == 1);
+            CHECK(builder.str() == "x");
+        }
+        {
+            StringBuilder builder;
+            builder.append("ab");
+            builder.reserve(1000);
+            builder.reserve(5000);
+            builder.append("cd");
+            CHECK(builder.str() == "abcd");
+        }
+        {
+            StringBuilder builder;
+            builder.append(std::string(3000, 'a'));
+            builder.clear();
+            builder.reserve(1000);
+            builder.reserve(50000);
+            builder.append("y");
+            CHECK(builder.str() == "y");
+            builder.append(std::string(60000, 'z'));
+            CHECK(builder.size() == 60001);
+            CHECK(builder.str() == "y" + std::string(60000, 'z'));
+        }
+    }
+
+    void parallelSearchTests() {
+        // Three 1 MB chunks before the match, so the search runs as pool tasks.
+        const std::string text = std::string(size_t{3} << 20, 'a') + "needle";
+        ThreadPool workers(3), none(0);
+        CHECK(String::ParallelSearchFirstSubString(text, "needle", true, workers) == (long long)(size_t{3} << 20));
+        CHECK(String::ParallelSearchFirstSubString(text, "NEEDLE", false, none) == (long long)(size_t{3} << 20));
+        CHECK(String::ParallelSearchFirstSubString(text, "needles", true, none) == -1);
+    }
+
+    /// =========================
+    /// BATCH MATH
+    /// =========================
+
+    /// Error of got in units in the last place of the exact value.
+    double ulpError(const double got, const long double exact) {
+        const double rounded = std::fabs((double)exact);
+        const double ulp = std::nextafter(rounded, INFINITY) - rounded;
+        return (double)(std::fabs((long double)got - exact) / ulp);
+    }
+
+    void logarithmTests() {
+        std::mt19937_64 rng(1);
+        std::vector<double> in(1 << 16), out(in.size());
+        for (double& x : in) {
+            x = std::ldexp(1.0 + double(rng() >> 11) * 0x1p-53, (int)(rng() % 400) - 200);
+        }
+        const SimdLevel previous = batch::GetSimdLevel();
+        for (const SimdLevel level : { SimdLevel::Scalar, SimdLevel::Avx2, SimdLevel::Avx512 }) {
+            batch::SetSimdLevel(level);
+            for (const double base : { 2.0, 10.0, std::numbers::e, 3.0, 0.5, 1.0001, 0.999, 1e-5, 123456.789 }) {
+                batch::Logarithm(base, in, out);
+                double worst = 0;
+                for (size_t i = 0; i < in.size(); i++) {
+                    const long double exact = std::log((long double)in[i]) / std::log((long double)base);
+                    if (exact != 0) {
+                        worst = std::max(worst, ulpError(out[i], exact));
+                    }
+                }
+                CHECK(worst <= 1.0); // documented bound
+            }
+        }
+        batch::SetSimdLevel(previous);
+    }
+
+    /// Worst error of batch(in..., out) against exact(i) on every SimdLevel.
+    template<typename Batch, typename Exact>
+    double worstUlpOnEveryLevel(const size_t count, Batch&& batched, Exact&& exact) {
+        std::vector<double> out(count);
+        double worst = 0;
+        const SimdLevel previous = batch::GetSimdLevel();
+        for (const SimdLevel level : { SimdLevel::Scalar, SimdLevel::Avx2, SimdLevel::Avx512 }) {
+            batch::SetSimdLevel(level);
+            batched(std::span<double>(out));
+            for (size_t i = 0; i < count; i++) {
+                worst = std::max(worst, ulpError(out[i], exact(i)));
+            }
+        }
+        batch::SetSimdLevel(previous);
+        return worst;
+    }
+
+    void tangentTests() {
+        std::mt19937_64 rng(2);
+        std::vector<double> in(1 << 16);
+        for (size_t i = 0; i < in.size(); i++) {
+            const double unit = double(rng() >> 11) * 0x1p-53;
+            switch (i % 3) {
+                case 0: in[i] = (unit - 0.5) * 20; break;
+                case 1: in[i] = std::ldexp(unit, (int)(rng() % 48) - 27); break; // up to 2^20
+                // Next to multiples of pi/4, where the reduced argument is tiny or the kernel switches forms.
+                default: in[i] = double((long double)(rng() % 4096) * 0.785398163397448309615660845819875721L) + (unit - 0.5) * 1e-6; break;
+            }
+            in[i] = (rng() & 1) ? -in[i] : in[i];
+        }
+        const double worst = worstUlpOnEveryLevel(in.size(), [&](std::span<double> out) { batch::tangent(in, out); },
+                                                  [&](const size_t i) { return std::tan((long double)in[i]); });
+        CHECK(worst <= 1.0); // documented bound
+    }
+
+    void powerTests() {
+        std::mt19937_64 rng(3);
+        std::vector<double> bases(1 << 16), exponents(bases.size());
+        for (size_t i = 0; i < bases.size(); i++) {
+            bases[i] = std::ldexp(1.0 + double(rng() >> 11) * 0x1p-53, i % 2 ? (int)(rng() % 201) - 100 : (int)(rng() % 3) - 1);
+            exponents[i] = (double(rng() >> 11) * 0x1p-53 - 0.5) * 8;
+        }
+        bases[0] = 1.3882274770022838;
+        exponents[0] = -3.1033700239844464;
+        const double worst = worstUlpOnEveryLevel(bases.size(), [&](std::span<double> out) { batch::power(bases, exponents, out); },
+                                                  [&](const size_t i) { return std::pow((long double)bases[i], (long double)exponents[i]); });
+        CHECK(worst <= 1.0); // documented bound for |exponent| <= 4
+    }
+
+    void rootTests() {
+        std::mt19937_64 rng(4);
+        std::vector<double> in(1 << 16);
+        for (double& x : in) {
+            x = std::ldexp(1.0 + double(rng() >> 11) * 0x1p-53, (int)(rng() % 2044) - 1022);
+        }
+        in[0] = 4.3483724420977747e-281;
+        for (const int degree : { 3, 4, 5, 7, 9 }) {
+            const double worst = worstUlpOnEveryLevel(in.size(), [&](std::span<double> out) { batch::n_Root(degree, in, out); },
+                                                      [&](const size_t i) {
+                // powl's 1 / degree rounds, so polish its answer with a Newton step in long double.
+                const long double x = in[i];
+                const long double y = std::pow(x, 1.0L / degree);
+                return y - (std::pow(y, (long double)degree) - x) / (degree * std::pow(y, (long double)(degree - 1)));
+            });
+            CHECK(worst <= 1.0); // documented bound
+        }
+    }
+
+    void parallelBatchTests() {
+        std::vector<double> in(100'000), serial(in.size()), pooled(in.size()), callerOnly(in.size());
+        for (size_t i = 0; i < in.size(); i++) {
+            in[i] = double(i) * 1e-3 - 50;
+        }
+        batch::sine(in, serial);
+        ThreadPool workers(3), none(0);
+        batch::parallel::sine(in, pooled, workers);
+        batch::parallel::sine(in, callerOnly, none);
+        CHECK(pooled == serial);
+        CHECK(callerOnly == serial);
+    }
+
+    /// =========================
+    /// RANDOM
+    /// =========================
+
+    void samplingTests() {
+        {
+            ReservoirSampler<int> sampler(0);
+            for (int i = 0; i < 100; i++) {
+                sampler.push(i);
+            }
+            CHECK(sampler.sample().empty());
+            CHECK(sampler.seen() == 100);
+        }
+        {
+            const std::vector<int> values = { 1, 2, 3, 4, 5 };
+            CHECK(ReservoirSample(values.begin(), values.end(), 0).empty());
+            CHECK(ReservoirSample(values.begin(), values.end(), 3).size() == 3);
+        }
+        {
+            const AliasTable empty;
+            CHECK(empty.size() == 0);
+            CHECK(empty() == AliasTable::npos);
+            const AliasTable none(std::span<const double>{});
+            std::vector<size_t> out(4, 0);
+            none.sample(out);
+            CHECK(out == std::vector<size_t>(4, AliasTable::npos));
+        }
+        {
+            const AliasTable table = { 0.0, 1.0 };
+            CHECK(table() == 1);
+        }
+    }
+
+    void shuffleTests() {
+        // Four 1 MB blocks, so two levels of merges run as pool tasks.
+        std::vector<uint32_t> pooled(1 << 20), callerOnly(pooled.size());
+        for (size_t i = 0; i < pooled.size(); i++) {
+            pooled[i] = callerOnly[i] = static_cast<uint32_t>(i);
+        }
+        ThreadPool workers(3), none(0);
+        ParallelShuffle(std::span<uint32_t>(pooled), 42, workers);
+        ParallelShuffle(std::span<uint32_t>(callerOnly), 42, none);
+        CHECK(pooled == callerOnly);
+        std::vector<uint32_t> sorted = pooled;
+        std::sort(sorted.begin(), sorted.end());
+        bool permutation = true;
+        for (size_t i = 0; i < sorted.size(); i++) {
+            permutation = permutation && sorted[i] == i;
+        }
+        CHECK(permutation);
+        size_t fixed = 0;
+        for (size_t i = 0; i < pooled.size(); i++) {
+            fixed += pooled[i] == i;
+        }
+        CHECK(fixed < 32); // about one fixed point is expected
+    }
+}
+
+int main() {
+    parseNumberTests();
+    inputReaderTests();
+    stringBuilderTests();
+    parallelSearchTests();
+    logarithmTests();
+    tangentTests();
+    powerTests();
+    rootTests();
+    parallelBatchTests();
+    samplingTests();
+    shuffleTests();
+    if (failures != 0) {
+        std::fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    std::fprintf(stderr, "all checks passed\n");
+    return 0;
+}